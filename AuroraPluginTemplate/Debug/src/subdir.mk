@@ -4,20 +4,26 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
-../src/AuroraPlugin.cpp 
+../src/AuroraPlugin.cpp \
+../src/MemoryTracker.cpp \
+../src/PaletteLut.cpp 
 
 OBJS += \
-./src/AuroraPlugin.o 
+./src/AuroraPlugin.o \
+./src/MemoryTracker.o \
+./src/PaletteLut.o 
 
 CPP_DEPS += \
-./src/AuroraPlugin.d 
+./src/AuroraPlugin.d \
+./src/MemoryTracker.d \
+./src/PaletteLut.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 src/%.o: ../src/%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: Cross G++ Compiler'
-	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	g++ -I../inc $(MEMORY_TRACKING_FLAGS) -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -0,0 +1,30 @@
+/*
+ * HashUtils.h
+ */
+
+#ifndef INC_HASHUTILS_H_
+#define INC_HASHUTILS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FNV_OFFSET_BASIS 1469598103934665603ull
+#define FNV_PRIME 1099511628211ull
+
+/**
+ * @description: 64-bit FNV-1a, start with hash = FNV_OFFSET_BASIS and chain calls to hash several buffers
+ * @params hash: the hash so far
+ * @params data: the bytes to add to the hash
+ * @params size: number of bytes in data
+ * @return: the updated hash
+ */
+static inline uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+#endif /* INC_HASHUTILS_H_ */
@@ -0,0 +1,70 @@
+/*
+ * MemoryTracker.h
+ */
+
+#ifndef INC_MEMORYTRACKER_H_
+#define INC_MEMORYTRACKER_H_
+
+#include <stddef.h>
+
+/*
+ * diagnostics only. Build with "make MEMORY_TRACKING=1" to define MEMORY_TRACKING_ENABLED, the makefile then also adds
+ * the link flags the tracker needs. "make MEMORY_TRACKING=assert" additionally defines MEMORY_ASSERT_NO_FRAME_ALLOCATIONS
+ */
+
+/*
+ * abort as soon as a frame allocates once the plugin has warmed up
+ */
+//#define MEMORY_ASSERT_NO_FRAME_ALLOCATIONS
+
+#if defined(MEMORY_ASSERT_NO_FRAME_ALLOCATIONS) && !defined(MEMORY_TRACKING_ENABLED)
+#error "MEMORY_ASSERT_NO_FRAME_ALLOCATIONS needs MEMORY_TRACKING_ENABLED, build with make MEMORY_TRACKING=assert"
+#endif
+
+#define MEMORY_WARMUP_FRAMES 10
+#define MEMORY_MAX_TRACKED_BLOCKS 1024	/*power of two, live blocks beyond this are counted but not sized*/
+
+/*
+ * The plugin replaces the global operator new and delete to measure its heap. Every block is charged to the subsystem
+ * that is current when it is allocated, and released from that same subsystem when it is deleted.
+ * The host and libPluginUtilities allocate through their own operator new and are not counted
+ */
+enum MemorySubsystem {
+	MEMORY_SUBSYSTEM_PLUGIN,
+	MEMORY_SUBSYSTEM_FRAME,
+	MEMORY_SUBSYSTEM_COUNT
+};
+
+#ifdef MEMORY_TRACKING_ENABLED
+
+/**
+ * @description: make subsystem the one that following allocations are charged to
+ * @return: the previously current subsystem, to be restored with setMemorySubsystem when done
+ */
+int setMemorySubsystem(int subsystem);
+
+/**
+ * @description: check that the plugin's operator new is the one its own code calls
+ * @return: true if allocations are being counted
+ */
+bool checkMemoryTracking();
+
+/**
+ * @description: bracket a call to getPluginFrame, every allocation in between is charged to the frame
+ */
+void beginMemoryFrame();
+void endMemoryFrame();
+
+/**
+ * @description: print the peak heap, live bytes per subsystem and allocations per frame
+ */
+void printMemoryReport();
+#else
+static inline int setMemorySubsystem(int subsystem) { return subsystem; }
+static inline bool checkMemoryTracking() { return false; }
+static inline void beginMemoryFrame() {}
+static inline void endMemoryFrame() {}
+static inline void printMemoryReport() {}
+#endif
+
+#endif /* INC_MEMORYTRACKER_H_ */
@@ -0,0 +1,58 @@
+/*
+ * PaletteLut.h
+ */
+
+#ifndef INC_PALETTELUT_H_
+#define INC_PALETTELUT_H_
+
+#include <stdint.h>
+#include "ColorUtils.h"
+
+#define PALETTE_LUT_SIZE 256
+
+/**
+ * A gradient through the user palette, sampled at PALETTE_LUT_SIZE points
+ */
+struct PaletteLut_t {
+	RGB_t colors[PALETTE_LUT_SIZE];
+	uint64_t paletteHash;			/*hash of the palette the gradient was built from*/
+};
+
+/**
+ * @description: build the gradient by interpolating in HSV between consecutive palette colors.
+ * An empty palette falls back to the plugin's default colors
+ * @params palette: the colors to interpolate between
+ * @params nColors: number of colors in palette
+ * @params lut: the table to fill in
+ */
+void buildPaletteLut(const RGB_t* palette, int nColors, PaletteLut_t* lut);
+
+/**
+ * @description: fetch the palette from the DataManager and rebuild lut if it changed since the last call
+ * @params lut: the table to update
+ * @return: true if the table was rebuilt
+ */
+bool updatePaletteLut(PaletteLut_t* lut);
+
+/**
+ * @description: map an energy value onto the gradient on a log2 scale. The twelve octaves below 4096 span the
+ * whole gradient, louder values saturate at its end
+ */
+static inline uint8_t energyToLutIndex(uint16_t energy) {
+	if (energy < 2) {
+		return 0;
+	}
+	int msb = 31 - __builtin_clz(energy);
+	int fraction = msb >= 4 ? (energy >> (msb - 4)) & 0xf : (energy << (4 - msb)) & 0xf;
+	int index = msb * 21 + ((fraction * 21) >> 4);
+	return index < PALETTE_LUT_SIZE ? index : PALETTE_LUT_SIZE - 1;
+}
+
+/**
+ * @description: map an fft band onto the gradient, low bands at the start and high bands at the end
+ */
+static inline uint8_t fftBandToLutIndex(int band, int nBands) {
+	return nBands > 1 ? band * (PALETTE_LUT_SIZE - 1) / (nBands - 1) : 0;
+}
+
+#endif /* INC_PALETTELUT_H_ */
@@ -17,12 +17,15 @@
 #include "AuroraPlugin.h"
 #include "LayoutProcessingUtils.h"
 #include "ColorUtils.h"
+#include "PaletteLut.h"
 #include "DataManager.h"
 #include "PluginFeatures.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +41,8 @@ extern "C" {
 
 #define MAX_SOURCES 1
 #define ADJACENT_PANEL_DISTANCE 86.599995
+#define FFT_BINS 32
+#define MAX_SOURCE_ENERGY 4000
 
 typedef struct Source {
 	double x, y;                // origin, const
@@ -45,15 +50,16 @@ typedef struct Source {
 	double rad;                 // radius of explosion, var
 	double lifetime;	          // lifetime of source, var
 	double remaining_lifetime;   // self explanatory
-	int r, g, b;                // red, green, blue
+	uint8_t lutIndex;           // color of the source in paletteLut, const
+	RGB_t color;                // lutIndex color faded by age, var
 } Source;
 
 int numSources = 0;
 
 LayoutData *layoutData = NULL;
+PaletteLut_t paletteLut;
 Source sources[MAX_SOURCES];
-
-void initSource(int index, int r, int g, int b, int lifeTime) {
+void initSource(int index, uint8_t lutIndex, int lifeTime) {
 	if (index < MAX_SOURCES) {
 		printf("Creating source\n");
 
@@ -70,9 +76,7 @@ void initSource(int index, int r, int g, int b, int lifeTime) {
 		sources[index].lifetime = lifeTime;
 		sources[index].remaining_lifetime = lifeTime;
 
-		sources[index].r = r;	// TODO - different based on frequency
-		sources[index].g = g;
-		sources[index].b = b;
+		sources[index].lutIndex = lutIndex;
 
 		numSources++;
 	}
@@ -101,9 +105,12 @@ void propagateSource(Source *source) {
  *
  */
 void initPlugin() {
+	checkMemoryTracking();
 	layoutData = getLayoutData();
+	updatePaletteLut(&paletteLut);
 	enableBeatFeatures();
 	enableEnergy();
+	enableFft(FFT_BINS);
 }
 
 /**
@@ -123,14 +130,34 @@ void initPlugin() {
  */
 void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
 
+	beginMemoryFrame();
+	updatePaletteLut(&paletteLut);
+
 	for (int i = numSources - 1; i >= 0; i--){
-		if (sources[i].remaining_lifetime < 0){
+		if (sources[i].remaining_lifetime <= 0){
 			deleteSource(i);
 		}
 	}
 	if (getIsBeat()) {
 		printf("beat\n");
-		initSource(numSources, rand()%256, rand()%256, rand()%256, 7);
+		// color the source by the loudest frequency band
+		uint8_t *fftBins = getFftBins();
+		int loudestBand = 0;
+		for (int i = 1; fftBins && i < FFT_BINS; i++) {
+			if (fftBins[i] > fftBins[loudestBand]) {
+				loudestBand = i;
+			}
+		}
+		initSource(numSources, fftBandToLutIndex(loudestBand, FFT_BINS), 7);
+	}
+
+	// fade each source out as it ages, once per frame
+	for (int iSource = 0; iSource < numSources; iSource++) {
+		const RGB_t &color = paletteLut.colors[sources[iSource].lutIndex];
+		double brightness = sources[iSource].remaining_lifetime / sources[iSource].lifetime;
+		sources[iSource].color.R = color.R * brightness;
+		sources[iSource].color.G = color.G * brightness;
+		sources[iSource].color.B = color.B * brightness;
 	}
 
 	for (int iPanel = 0; iPanel < layoutData->nPanels; iPanel++) {
@@ -142,9 +169,10 @@ void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
 		for (int iSource = 0; iSource < numSources; iSource++) {
 			double dist = Point::distance(layoutData->panels[iPanel].shape->getCentroid(), Point(sources[iSource].x, sources[iSource].y));
 			if (abs(dist - sources[iSource].rad) <= 50) {
-				frames[iPanel].r = sources[iSource].r; //* (double)sources[iSource].remaining_lifetime / sources[iSource].lifetime;
-				frames[iPanel].g = sources[iSource].g; //* (double)sources[iSource].remaining_lifetime / sources[iSource].lifetime;
-				frames[iPanel].b = sources[iSource].b; //* (double)sources[iSource].remaining_lifetime / sources[iSource].lifetime;
+				const RGB_t &color = sources[iSource].color;
+				frames[iPanel].r = color.R;
+				frames[iPanel].g = color.G;
+				frames[iPanel].b = color.B;
 				frames[iPanel].transTime = 0;
 			} else {
 				frames[iPanel].r = 0;
@@ -163,22 +191,10 @@ void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
 uint16_t energyValue = getEnergy();
 printf("energy %d\n", energyValue);
 
-if (energyValue>2000 && energyValue<4000){
-	initSource(numSources,255,181,51,2); //orange
-}
-else if (energyValue>0&&energyValue<10)
-{
-	initSource(numSources,51,224,225,2); //sky blue
-}
-else if (energyValue<20&&energyValue>10){
-	initSource(numSources,175,51,255,2); //purple
-}
-else if (energyValue>20&&energyValue<100){
-	initSource(numSources,167,78,23,2); //dark orange
-}
-else if (energyValue>100&&energyValue<2000){
-	initSource(numSources,134,98,28,2); //dark yellow
+if (energyValue > 0 && energyValue < MAX_SOURCE_ENERGY) {
+	initSource(numSources, energyToLutIndex(energyValue), 2);
 }
+	endMemoryFrame();
 }
 
 /**
@@ -187,4 +203,5 @@ else if (energyValue>100&&energyValue<2000){
  */
 void pluginCleanup(){
 	//do deallocation here
+	printMemoryReport();
 }
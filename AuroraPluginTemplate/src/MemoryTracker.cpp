@@ -0,0 +1,251 @@
+/*
+ * MemoryTracker.cpp
+ */
+
+#include "MemoryTracker.h"
+
+#ifdef MEMORY_TRACKING_ENABLED
+
+#include "Logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define mallocUsableSize(ptr) malloc_size(ptr)
+#else
+#include <malloc.h>
+#define mallocUsableSize(ptr) malloc_usable_size(ptr)
+#endif
+
+static const char* subsystemNames[MEMORY_SUBSYSTEM_COUNT] = {
+	"plugin",
+	"frame",
+};
+
+/*
+ * the live blocks handed out by operator new, in an open addressing table keyed by pointer. Keeping the owner out of
+ * the block itself leaves it a plain malloc block, which libstdc++'s delete can still free
+ */
+struct TrackedBlock_t {
+	void* ptr;					/*NULL for an empty slot*/
+	size_t size;
+	int subsystem;
+};
+
+static TrackedBlock_t trackedBlocks[MEMORY_MAX_TRACKED_BLOCKS];
+static int nTrackedBlocks = 0;
+static unsigned long nUntrackedBlocks = 0;	/*allocated while the table was full*/
+static unsigned long nForeignFrees = 0;		/*deleted here but not in the table*/
+
+static int currentSubsystem = MEMORY_SUBSYSTEM_PLUGIN;
+static size_t liveBytes[MEMORY_SUBSYSTEM_COUNT];
+static unsigned long nAllocations[MEMORY_SUBSYSTEM_COUNT];
+static size_t totalLiveBytes = 0;
+static size_t peakBytes = 0;
+static bool isTrackingActive = false;
+
+static bool inFrame = false;
+static int frameSubsystem = MEMORY_SUBSYSTEM_PLUGIN;
+static unsigned long nFrames = 0;
+static unsigned long frameAllocations = 0;
+static unsigned long lastFrameAllocations = 0;
+static unsigned long maxSteadyFrameAllocations = 0;
+
+static size_t getBlockSlot(void* ptr) {
+	uintptr_t hash = (uintptr_t)ptr >> 4;
+	hash ^= hash >> 10;
+	return hash & (MEMORY_MAX_TRACKED_BLOCKS - 1);
+}
+
+/*
+ * keep the table at most 3/4 full so probe sequences stay short
+ */
+static bool trackBlock(void* ptr, size_t size, int subsystem) {
+	if (nTrackedBlocks >= MEMORY_MAX_TRACKED_BLOCKS / 4 * 3) {
+		return false;
+	}
+	size_t slot = getBlockSlot(ptr);
+	while (trackedBlocks[slot].ptr) {
+		slot = (slot + 1) & (MEMORY_MAX_TRACKED_BLOCKS - 1);
+	}
+	trackedBlocks[slot].ptr = ptr;
+	trackedBlocks[slot].size = size;
+	trackedBlocks[slot].subsystem = subsystem;
+	nTrackedBlocks++;
+	return true;
+}
+
+/*
+ * remove ptr from the table, shifting back the entries that probed past its slot
+ * @return: false if ptr was not in the table
+ */
+static bool untrackBlock(void* ptr, TrackedBlock_t* block) {
+	size_t slot = getBlockSlot(ptr);
+	while (trackedBlocks[slot].ptr != ptr) {
+		if (!trackedBlocks[slot].ptr) {
+			return false;
+		}
+		slot = (slot + 1) & (MEMORY_MAX_TRACKED_BLOCKS - 1);
+	}
+	*block = trackedBlocks[slot];
+	trackedBlocks[slot].ptr = NULL;
+	nTrackedBlocks--;
+
+	size_t hole = slot;
+	for (size_t next = (slot + 1) & (MEMORY_MAX_TRACKED_BLOCKS - 1); trackedBlocks[next].ptr;
+			next = (next + 1) & (MEMORY_MAX_TRACKED_BLOCKS - 1)) {
+		size_t home = getBlockSlot(trackedBlocks[next].ptr);
+		bool homeBetween = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+		if (!homeBetween) {
+			trackedBlocks[hole] = trackedBlocks[next];
+			trackedBlocks[next].ptr = NULL;
+			hole = next;
+		}
+	}
+	return true;
+}
+
+int setMemorySubsystem(int subsystem) {
+	int previous = currentSubsystem;
+	currentSubsystem = subsystem;
+	return previous;
+}
+
+bool checkMemoryTracking() {
+	unsigned long before = nAllocations[currentSubsystem];
+	::operator delete(::operator new(1));
+	isTrackingActive = nAllocations[currentSubsystem] != before;
+	if (!isTrackingActive) {
+		PRINTLOG("memory tracking is not active, operator new resolves outside the plugin\n");
+#ifdef MEMORY_ASSERT_NO_FRAME_ALLOCATIONS
+		fflush(stdout);
+		abort();
+#endif
+	}
+	return isTrackingActive;
+}
+
+void beginMemoryFrame() {
+	frameAllocations = 0;
+	inFrame = true;
+	frameSubsystem = setMemorySubsystem(MEMORY_SUBSYSTEM_FRAME);
+}
+
+void endMemoryFrame() {
+	setMemorySubsystem(frameSubsystem);
+	inFrame = false;
+	nFrames++;
+	lastFrameAllocations = frameAllocations;
+	if (nFrames > MEMORY_WARMUP_FRAMES && frameAllocations > maxSteadyFrameAllocations) {
+		maxSteadyFrameAllocations = frameAllocations;
+	}
+#ifdef MEMORY_ASSERT_NO_FRAME_ALLOCATIONS
+	if (nFrames > MEMORY_WARMUP_FRAMES && frameAllocations > 0) {
+		PRINTLOG("frame %lu allocated %lu times after warmup\n", nFrames, frameAllocations);
+		printMemoryReport();
+		fflush(stdout);
+		abort();
+	}
+#endif
+}
+
+void printMemoryReport() {
+	PRINTLOG("memory%s: peak heap %zu bytes, live %zu bytes in %d blocks\n", isTrackingActive ? "" : " (tracking not active)",
+			peakBytes, totalLiveBytes, nTrackedBlocks);
+	for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+		PRINTLOG("  %-12s %zu bytes live, %lu allocations\n", subsystemNames[i], liveBytes[i], nAllocations[i]);
+	}
+	if (nUntrackedBlocks || nForeignFrees) {
+		PRINTLOG("  %lu blocks not sized (table full), %lu frees of unsized or foreign blocks\n",
+				nUntrackedBlocks, nForeignFrees);
+	}
+	PRINTLOG("  %lu frames, %lu allocations last frame, at most %lu per frame after warmup\n",
+			nFrames, lastFrameAllocations, maxSteadyFrameAllocations);
+}
+
+/*
+ * replacements for the global allocation functions. They forward to malloc and free like the default ones, so a block
+ * allocated on one side and released on the other (e.g. by libPluginUtilities) stays valid, and take the block size
+ * from the allocator
+ */
+static void* countedNew(size_t size) {
+	void* ptr = malloc(size ? size : 1);
+	if (ptr) {
+		nAllocations[currentSubsystem]++;
+		if (inFrame) {
+			frameAllocations++;
+		}
+		size_t usableSize = mallocUsableSize(ptr);
+		if (trackBlock(ptr, usableSize, currentSubsystem)) {
+			liveBytes[currentSubsystem] += usableSize;
+			totalLiveBytes += usableSize;
+			if (totalLiveBytes > peakBytes) {
+				peakBytes = totalLiveBytes;
+			}
+		} else {
+			nUntrackedBlocks++;
+		}
+	}
+	return ptr;
+}
+
+static void countedDelete(void* ptr) {
+	if (ptr) {
+		TrackedBlock_t block;
+		if (untrackBlock(ptr, &block)) {
+			liveBytes[block.subsystem] -= block.size;
+			totalLiveBytes -= block.size;
+		} else {
+			nForeignFrees++;
+		}
+		free(ptr);
+	}
+}
+
+void* operator new(size_t size) {
+	void* ptr = countedNew(size);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return countedNew(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return countedNew(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	countedDelete(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	countedDelete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+	countedDelete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+	countedDelete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	countedDelete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	countedDelete(ptr);
+}
+
+#endif /* MEMORY_TRACKING_ENABLED */
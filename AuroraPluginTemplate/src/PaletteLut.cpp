@@ -0,0 +1,80 @@
+/*
+ * PaletteLut.cpp
+ */
+
+#include "PaletteLut.h"
+#include "DataManager.h"
+#include "HashUtils.h"
+
+/*
+ * used when the user palette is empty, ordered from low to high energy
+ */
+static const RGB_t defaultPalette[] = {
+	{51, 224, 225},		//sky blue
+	{175, 51, 255},		//purple
+	{167, 78, 23},		//dark orange
+	{134, 98, 28},		//dark yellow
+	{255, 181, 51},		//orange
+};
+
+static uint64_t hashPalette(const RGB_t* palette, int nColors) {
+	uint64_t hash = hashBytes(FNV_OFFSET_BASIS, &nColors, sizeof(nColors));
+	return nColors > 0 ? hashBytes(hash, palette, nColors * sizeof(RGB_t)) : hash;
+}
+
+/*
+ * interpolate hue along the shorter way around the color wheel
+ */
+static HSV_t interpolateHSV(HSV_t from, HSV_t to, double t) {
+	int dH = to.H - from.H;
+	if (dH > 180) {
+		dH -= 360;
+	} else if (dH < -180) {
+		dH += 360;
+	}
+	HSV_t hsv;
+	hsv.H = ((int)(from.H + dH * t + 0.5) + 360) % 360;
+	hsv.S = (int)(from.S + (to.S - from.S) * t + 0.5);
+	hsv.V = (int)(from.V + (to.V - from.V) * t + 0.5);
+	return hsv;
+}
+
+void buildPaletteLut(const RGB_t* palette, int nColors, PaletteLut_t* lut) {
+	lut->paletteHash = hashPalette(palette, nColors);
+	if (nColors <= 0) {
+		palette = defaultPalette;
+		nColors = sizeof(defaultPalette) / sizeof(defaultPalette[0]);
+	}
+	if (nColors == 1) {
+		for (int i = 0; i < PALETTE_LUT_SIZE; i++) {
+			lut->colors[i] = palette[0];
+		}
+		return;
+	}
+
+	for (int i = 0; i < PALETTE_LUT_SIZE; i++) {
+		double position = (double)i * (nColors - 1) / (PALETTE_LUT_SIZE - 1);
+		int segment = (int)position;
+		if (segment >= nColors - 1) {
+			segment = nColors - 2;
+		}
+		HSV_t from, to;
+		RGBtoHSV(palette[segment], &from);
+		RGBtoHSV(palette[segment + 1], &to);
+		HSVtoRGB(interpolateHSV(from, to, position - segment), &lut->colors[i]);
+	}
+}
+
+bool updatePaletteLut(PaletteLut_t* lut) {
+	RGB_t* palette = NULL;
+	int nColors = 0;
+	getColorPalette(&palette, &nColors);
+	if (!palette) {
+		nColors = 0;
+	}
+	if (hashPalette(palette, nColors) == lut->paletteHash) {
+		return false;
+	}
+	buildPaletteLut(palette, nColors, lut);
+	return true;
+}